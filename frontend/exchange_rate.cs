@@ -9,6 +9,21 @@ namespace WinFormsApp_ant.UIPlugins
     [pluginArg(name = "Exchange_rate", index = 2, type = "其他", text = "港股历史汇率走势", single = true)]
     public partial class exchange_rate : BasePluginForm
     {
+        // Last responses per "startDate-endDate", kept across form reloads so the backend can
+        // answer with a small notModified message instead of resending the same range.
+        // Bounded to the most recently used ranges.
+        private class CachedRange
+        {
+            public long DataVersion;
+            public string DataHash = "";
+            public string DataJson = "";
+            public long LastUsed;
+        }
+        private const int MaxCachedRanges = 8;
+        private static readonly Dictionary<string, CachedRange> rangeCache = new();
+        private static readonly object rangeCacheLock = new();
+        private static long rangeCacheClock = 0;
+
         public exchange_rate()
         {
             InitializeComponent();
@@ -82,17 +97,34 @@ namespace WinFormsApp_ant.UIPlugins
             if (startDatePicker == null || endDatePicker == null)
                 return;
 
+            string startDate = startDatePicker.Value.ToString("yyyyMMdd");
+            string endDate = endDatePicker.Value.ToString("yyyyMMdd");
+            await RequestRangeAsync(startDate, endDate, conditional: true);
+        }
+
+        private async Task RequestRangeAsync(string startDate, string endDate, bool conditional)
+        {
             try
             {
-                string startDate = startDatePicker.Value.ToString("yyyyMMdd");
-                string endDate = endDatePicker.Value.ToString("yyyyMMdd");
-
                 var dict_data = new Dictionary<string, object>
                 {
                     { "startDate", startDate },
                     { "endDate", endDate }
                 };
 
+                // Conditional request: let the backend skip the payload if our copy is current
+                if (conditional)
+                {
+                    lock (rangeCacheLock)
+                    {
+                        if (rangeCache.TryGetValue($"{startDate}-{endDate}", out var cached))
+                        {
+                            dict_data["ifVersion"] = cached.DataVersion;
+                            dict_data["ifHash"] = cached.DataHash;
+                        }
+                    }
+                }
+
                 var pluginArg = GetType().GetCustomAttribute<pluginArgAttribute>();
                 
                 // Debug: Log request being sent
@@ -127,7 +159,7 @@ namespace WinFormsApp_ant.UIPlugins
             }
             catch (Exception ex)
             {
-                System.Diagnostics.Debug.WriteLine($"[ExchangeRate] Error in LoadDataAsync: {ex.Message}\n{ex.StackTrace}");
+                System.Diagnostics.Debug.WriteLine($"[ExchangeRate] Error in RequestRangeAsync: {ex.Message}\n{ex.StackTrace}");
             }
         }
 
@@ -153,34 +185,107 @@ namespace WinFormsApp_ant.UIPlugins
                 string? dataJsonString = null;
                 int arrayLength = 0;
 
-                // Check if root is an array (direct array response - unlikely but possible)
-                if (root.ValueKind == JsonValueKind.Array)
+                string? rangeKey = null;
+                string? rangeStart = null;
+                string? rangeEnd = null;
+                if (root.ValueKind == JsonValueKind.Object &&
+                    root.TryGetProperty("startDate", out JsonElement startElement) &&
+                    root.TryGetProperty("endDate", out JsonElement endElement))
                 {
-                    System.Diagnostics.Debug.WriteLine("[ExchangeRate] Root is array, using directly");
-                    dataJsonString = root.GetRawText();
-                    arrayLength = root.GetArrayLength();
+                    rangeStart = startElement.GetString();
+                    rangeEnd = endElement.GetString();
+                    rangeKey = $"{rangeStart}-{rangeEnd}";
                 }
-                // If wrapped in structure, try to find array in "data" field (expected format)
-                else if (root.TryGetProperty("data", out JsonElement dataElement) && 
-                         dataElement.ValueKind == JsonValueKind.Array)
+
+                // notModified: backend data is unchanged, reuse the copy cached for this range
+                if (root.ValueKind == JsonValueKind.Object &&
+                    root.TryGetProperty("notModified", out JsonElement notModifiedElement) &&
+                    notModifiedElement.ValueKind == JsonValueKind.True)
                 {
-                    arrayLength = dataElement.GetArrayLength();
-                    System.Diagnostics.Debug.WriteLine($"[ExchangeRate] Found data array with {arrayLength} items");
-                    dataJsonString = dataElement.GetRawText();
+                    lock (rangeCacheLock)
+                    {
+                        if (rangeKey != null && rangeCache.TryGetValue(rangeKey, out var cached))
+                        {
+                            if (root.TryGetProperty("dataVersion", out JsonElement versionElement) &&
+                                versionElement.ValueKind == JsonValueKind.Number)
+                            {
+                                cached.DataVersion = versionElement.GetInt64();
+                            }
+                            cached.LastUsed = ++rangeCacheClock;
+                            dataJsonString = cached.DataJson;
+                        }
+                    }
+                    if (dataJsonString == null)
+                    {
+                        // Cached copy was evicted between request and reply: ask again for the full range
+                        System.Diagnostics.Debug.WriteLine($"[ExchangeRate] notModified received but no cached copy for {rangeKey}, re-requesting unconditionally");
+                        if (rangeStart != null && rangeEnd != null)
+                        {
+                            _ = RequestRangeAsync(rangeStart, rangeEnd, conditional: false);
+                        }
+                        return;
+                    }
+                    System.Diagnostics.Debug.WriteLine($"[ExchangeRate] Data not modified for range {rangeKey}, using cached copy");
                 }
-                // If root is object but no "data" field, check if it's the array itself
-                else if (root.ValueKind == JsonValueKind.Object)
+                else if (rangeKey != null &&
+                    root.TryGetProperty("data", out JsonElement rangeData) &&
+                    rangeData.ValueKind == JsonValueKind.Array &&
+                    root.TryGetProperty("dataVersion", out JsonElement dataVersionElement) &&
+                    dataVersionElement.ValueKind == JsonValueKind.Number &&
+                    root.TryGetProperty("dataHash", out JsonElement dataHashElement) &&
+                    dataHashElement.ValueKind == JsonValueKind.String)
                 {
-                    // Backend might send the array directly as the message body
-                    // Try to find any array property
-                    foreach (var prop in root.EnumerateObject())
+                    lock (rangeCacheLock)
                     {
-                        if (prop.Value.ValueKind == JsonValueKind.Array)
+                        rangeCache[rangeKey] = new CachedRange
                         {
-                            System.Diagnostics.Debug.WriteLine($"[ExchangeRate] Found array in property: {prop.Name}");
-                            dataJsonString = prop.Value.GetRawText();
-                            arrayLength = prop.Value.GetArrayLength();
-                            break;
+                            DataVersion = dataVersionElement.GetInt64(),
+                            DataHash = dataHashElement.GetString() ?? "",
+                            DataJson = rangeData.GetRawText(),
+                            LastUsed = ++rangeCacheClock
+                        };
+
+                        // Evict the least recently used range once over the limit
+                        if (rangeCache.Count > MaxCachedRanges)
+                        {
+                            string oldestKey = rangeCache.OrderBy(kv => kv.Value.LastUsed).First().Key;
+                            rangeCache.Remove(oldestKey);
+                        }
+                    }
+                }
+
+                // Not resolved from the cache: extract the data array from the response
+                if (dataJsonString == null)
+                {
+                    // Check if root is an array (direct array response - unlikely but possible)
+                    if (root.ValueKind == JsonValueKind.Array)
+                    {
+                        System.Diagnostics.Debug.WriteLine("[ExchangeRate] Root is array, using directly");
+                        dataJsonString = root.GetRawText();
+                        arrayLength = root.GetArrayLength();
+                    }
+                    // If wrapped in structure, try to find array in "data" field (expected format)
+                    else if (root.TryGetProperty("data", out JsonElement dataElement) && 
+                             dataElement.ValueKind == JsonValueKind.Array)
+                    {
+                        arrayLength = dataElement.GetArrayLength();
+                        System.Diagnostics.Debug.WriteLine($"[ExchangeRate] Found data array with {arrayLength} items");
+                        dataJsonString = dataElement.GetRawText();
+                    }
+                    // If root is object but no "data" field, check if it's the array itself
+                    else if (root.ValueKind == JsonValueKind.Object)
+                    {
+                        // Backend might send the array directly as the message body
+                        // Try to find any array property
+                        foreach (var prop in root.EnumerateObject())
+                        {
+                            if (prop.Value.ValueKind == JsonValueKind.Array)
+                            {
+                                System.Diagnostics.Debug.WriteLine($"[ExchangeRate] Found array in property: {prop.Name}");
+                                dataJsonString = prop.Value.GetRawText();
+                                arrayLength = prop.Value.GetArrayLength();
+                                break;
+                            }
                         }
                     }
                 }
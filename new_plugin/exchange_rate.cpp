@@ -9,6 +9,13 @@
 #include <memory>
 #include <vector>
 #include <mutex>
+#include <cstdint>
+#include <cstdlib>
+#include <cerrno>
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include <fstream>
 #include <json.hpp>
 
 
@@ -33,31 +40,39 @@ public:
             );
         }
 
-        // Create Input instance for data access
-        m_input = std::make_unique<Tools::Input>();
-
         // Preload fixed date range data into cache
         // Start date: 2025-01-01, End date: 2025-11-28
         std::string startDate = "20250101";
         std::string endDate   = "20251128";
 
-        Tools::Logger::info("Loading exchange rate data from " + startDate + " to " + endDate);
-
         // Load one year of exchange rate data into cache
         try {
-            nlohmann::json data = m_input->get_mysql_data(
-                "sunjq",
-                "hk_exchange_rate",
-                { { "tradeDateKey >= %s", startDate },
-                  { "tradeDateKey <= %s", endDate } }
-            );
+            nlohmann::json data;
+            auto dataFileIt = parameters.find("dataFile");
+            if (dataFileIt != parameters.end() && !dataFileIt->second.empty()) {
+                // Offline mode: read records from a local JSON file instead of MySQL
+                // (e.g. a fixture written by exchange_rate_loadgen --gen-fixture)
+                Tools::Logger::info("Loading exchange rate data from file: " + dataFileIt->second);
+                std::ifstream in(dataFileIt->second);
+                if (!in) {
+                    throw std::runtime_error("cannot open data file " + dataFileIt->second);
+                }
+                data = nlohmann::json::parse(in);
+            }
+            else {
+                // Create Input instance for data access (MySQL only; offline mode never touches it)
+                m_input = std::make_unique<Tools::Input>();
 
-            {
-                std::lock_guard<std::mutex> lock(m_cacheMutex);
-                m_cachedExchangeRateData = data;
+                Tools::Logger::info("Loading exchange rate data from " + startDate + " to " + endDate);
+                data = m_input->get_mysql_data(
+                    "sunjq",
+                    "hk_exchange_rate",
+                    { { "tradeDateKey >= %s", startDate },
+                      { "tradeDateKey <= %s", endDate } }
+                );
             }
 
-            Tools::Logger::info("Cached " + std::to_string(data.size()) + " exchange rate records");
+            size_t recordCount = data.size();
 
             // Log first few records as sample to show what data looks like
             int maxSample = 5;
@@ -69,21 +84,19 @@ public:
                     ++idx;
                 }
             }
+
+            replaceCache(std::move(data));
+
+            Tools::Logger::info("Cached " + std::to_string(recordCount) + " exchange rate records");
         }
         catch (const std::exception& e) {
             Tools::Logger::error(std::string("Failed to load exchange rate data: ") + e.what());
             // Initialize empty cache on error
-            {
-                std::lock_guard<std::mutex> lock(m_cacheMutex);
-                m_cachedExchangeRateData = nlohmann::json::array();
-            }
+            replaceCache(nlohmann::json::array());
         }
         catch (...) {
             Tools::Logger::error("Unknown exception while loading exchange rate data");
-            {
-                std::lock_guard<std::mutex> lock(m_cacheMutex);
-                m_cachedExchangeRateData = nlohmann::json::array();
-            }
+            replaceCache(nlohmann::json::array());
         }
 
         // Keep plugin running
@@ -102,6 +115,70 @@ private:
     std::unique_ptr<Tools::Input> m_input;   // 行情 & 数据访问实例
     nlohmann::json m_cachedExchangeRateData;  // Cached exchange rate data (one year)
     std::mutex m_cacheMutex;                  // Mutex for thread-safe cache access
+    uint64_t m_dataVersion = 0;               // Cache snapshot version, bumped on every reload
+    std::map<std::pair<std::string, std::string>, std::string> m_rangeHashes;  // Content hash per (startDate, endDate) for m_dataVersion
+
+    static constexpr size_t kMaxRangeHashes = 4096;
+
+    // Replace the cached snapshot and give it a new data version. The version is seeded from
+    // wall-clock milliseconds so it keeps increasing across plugin restarts, which lets clients
+    // holding a version from an earlier process never match a newer snapshot by accident.
+    void replaceCache(nlohmann::json data) {
+        uint64_t nowMs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+
+        uint64_t version = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_cacheMutex);
+            m_cachedExchangeRateData = std::move(data);
+            m_dataVersion = std::max(m_dataVersion + 1, nowMs);
+            m_rangeHashes.clear();
+            version = m_dataVersion;
+        }
+        Tools::Logger::info("Exchange rate cache version: " + std::to_string(version));
+    }
+
+    // 64-bit FNV-1a over the serialized records, as 16 hex digits
+    static std::string hashRecords(const nlohmann::json& records) {
+        uint64_t h = 14695981039346656037ULL;
+        for (unsigned char c : records.dump()) {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        static const char digits[] = "0123456789abcdef";
+        std::string hex(16, '0');
+        for (int i = 15; i >= 0; --i) {
+            hex[i] = digits[h & 0xF];
+            h >>= 4;
+        }
+        return hex;
+    }
+
+    // Parse a decimal version string; rejects signs, whitespace, trailing junk and overflow
+    static bool parseVersion(const std::string& text, uint64_t& version) {
+        if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) {
+            return false;
+        }
+        errno = 0;
+        char* end = nullptr;
+        unsigned long long value = std::strtoull(text.c_str(), &end, 10);
+        if (errno == ERANGE || end != text.c_str() + text.size()) {
+            return false;
+        }
+        version = static_cast<uint64_t>(value);
+        return true;
+    }
+
+    // Read an optional conditional-request field from the top level or from "arg"
+    static nlohmann::json getRequestField(const json& message, const char* key) {
+        if (message.contains(key)) {
+            return message[key];
+        }
+        if (message.contains("arg") && message["arg"].is_object() && message["arg"].contains(key)) {
+            return message["arg"][key];
+        }
+        return nullptr;
+    }
 
     void handleClient(connection_hdl hdl, json message) {
         // Receive client request
@@ -200,15 +277,54 @@ private:
                 return;
             }
 
+            // Conditional request: client sends the dataVersion/dataHash of the copy it already holds
+            // for this range as ifVersion/ifHash. A malformed ifVersion is ignored, not an error.
+            bool hasIfVersion = false;
+            uint64_t ifVersion = 0;
+            nlohmann::json ifVersionField = getRequestField(message, "ifVersion");
+            if (ifVersionField.is_number_unsigned()) {
+                ifVersion = ifVersionField.get<uint64_t>();
+                hasIfVersion = true;
+            }
+            else if (ifVersionField.is_string()) {
+                hasIfVersion = parseVersion(ifVersionField.get<std::string>(), ifVersion);
+            }
+            if (!hasIfVersion && !ifVersionField.is_null()) {
+                Tools::Logger::info("Ignoring malformed ifVersion: " + ifVersionField.dump());
+            }
+
+            std::string ifHash;
+            nlohmann::json ifHashField = getRequestField(message, "ifHash");
+            if (ifHashField.is_string()) {
+                ifHash = ifHashField.get<std::string>();
+            }
+
             Tools::Logger::info("Filter exchange rate data, startDate: " + startDate + ", endDate: " + endDate);
 
             // Filter data from cache based on date range
             nlohmann::json filteredData = nlohmann::json::array();
-            
+            uint64_t dataVersion = 0;
+            std::string dataHash;
+            bool notModified = false;
+
             {
                 std::lock_guard<std::mutex> lock(m_cacheMutex);
-                
-                if (m_cachedExchangeRateData.is_array()) {
+                dataVersion = m_dataVersion;
+
+                auto hashIt = m_rangeHashes.find(std::make_pair(startDate, endDate));
+                if (hashIt != m_rangeHashes.end()) {
+                    dataHash = hashIt->second;
+                }
+
+                // Same snapshot, or a known hash for this range that the client already has:
+                // nothing to filter or serialize
+                if (hasIfVersion && ifVersion == dataVersion) {
+                    notModified = true;
+                }
+                else if (!ifHash.empty() && dataHash == ifHash) {
+                    notModified = true;
+                }
+                else if (m_cachedExchangeRateData.is_array()) {
                     for (const auto& record : m_cachedExchangeRateData) {
                         if (record.is_object() && record.contains("tradeDateKey")) {
                             // Get tradeDateKey value (could be int or string)
@@ -231,6 +347,40 @@ private:
                 }
             }
 
+            if (!notModified) {
+                if (dataHash.empty()) {
+                    dataHash = hashRecords(filteredData);
+                    std::lock_guard<std::mutex> lock(m_cacheMutex);
+                    if (m_dataVersion == dataVersion) {
+                        if (m_rangeHashes.size() >= kMaxRangeHashes) {
+                            m_rangeHashes.clear();
+                        }
+                        m_rangeHashes[std::make_pair(startDate, endDate)] = dataHash;
+                    }
+                }
+                // Snapshot changed but this range did not
+                notModified = !ifHash.empty() && dataHash == ifHash;
+            }
+
+            if (notModified) {
+                nlohmann::json response;
+                response["pluginArg"]["name"] = pluginName;
+                if (!instanceId.empty()) {
+                    response["pluginArg"]["instanceId"] = instanceId;
+                }
+                response["startDate"] = startDate;
+                response["endDate"] = endDate;
+                response["notModified"] = true;
+                response["dataVersion"] = dataVersion;
+                if (!dataHash.empty()) {
+                    response["dataHash"] = dataHash;
+                }
+
+                Tools::Logger::info("Exchange rate data not modified (version " + std::to_string(dataVersion) + "), sending notModified");
+                m_webSocketServer->sendClient(hdl, pluginName, response);
+                return;
+            }
+
             Tools::Logger::info("Filtered " + std::to_string(filteredData.size()) + " records from cache");
 
             // Log first few filtered records as sample to show response content
@@ -246,6 +396,7 @@ private:
 
             // Build response message with pluginArg for frontend routing
             // Frontend expects: { "pluginArg": { "name": "...", "instanceId": "..." }, "data": [...] }
+            // plus startDate/endDate, dataVersion and dataHash for later conditional requests
             nlohmann::json response;
             
             // Build response with pluginArg and data
@@ -253,6 +404,10 @@ private:
             if (!instanceId.empty()) {
                 response["pluginArg"]["instanceId"] = instanceId;
             }
+            response["startDate"] = startDate;
+            response["endDate"] = endDate;
+            response["dataVersion"] = dataVersion;
+            response["dataHash"] = dataHash;
             response["data"] = filteredData;
 
             // Log response before sending
@@ -0,0 +1,479 @@
+// Load generator for the Exchange_rate plugin WebSocket protocol.
+//
+// Opens N concurrent WebSocket connections to a running plugin host and, on each
+// connection, replays a weighted mix of startDate/endDate range requests in a closed
+// loop (one request in flight per connection). Requests carry the same
+// { "pluginArg": { "name", "instanceId" }, "startDate", "endDate" } shape that
+// frontend/WebSocketClient.cs sends. At the end it reports throughput,
+// p50/p99/p999 latency and bytes per second. Connections the host closes mid-run are
+// counted, and the exit status is 2 when no request completed or every connection was
+// lost, so regression scripts can fail on it.
+//
+// With --conditional each connection resends the dataVersion/dataHash it last received
+// for a range as ifVersion/ifHash, so the run measures the notModified path.
+//
+// For offline runs start the host with the Exchange_rate "dataFile" parameter pointing
+// at a fixture produced by --gen-fixture, so no MySQL instance is needed.
+//
+// Examples:
+//   exchange_rate_loadgen --gen-fixture rates.json --from 20240101 --to 20251128
+//   exchange_rate_loadgen --url ws://127.0.0.1:8080/ws?token=token123
+//       --connections 64 --duration 30 --mix 20251101:20251125:8,20250101:20251128:1
+
+#include <websocketpp/config/asio_no_tls_client.hpp>
+#include <websocketpp/client.hpp>
+#include <json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+typedef websocketpp::client<websocketpp::config::asio_client> WsClient;
+typedef std::chrono::steady_clock Clock;
+
+namespace {
+
+struct RangeSpec {
+    std::string startDate;
+    std::string endDate;
+    unsigned weight = 1;
+};
+
+struct Options {
+    std::string url = "ws://127.0.0.1:8080/ws?token=token123";
+    std::string pluginName = "Exchange_rate";
+    int connections = 16;
+    int durationSec = 30;
+    unsigned seed = 1;
+    bool conditional = false;
+    std::vector<RangeSpec> mix;
+
+    std::string fixturePath;
+    std::string fixtureFrom = "20240101";
+    std::string fixtureTo = "20251231";
+};
+
+struct ConnState {
+    websocketpp::connection_hdl hdl;
+    std::string instanceId;
+    std::mt19937 rng;
+    Clock::time_point sentAt;
+    size_t rangeIdx = 0;
+    std::vector<std::pair<uint64_t, std::string>> lastSeen;  // (dataVersion, dataHash) per mix entry
+    bool inFlight = false;
+    bool open = false;
+    bool finished = false;  // handshake failed or connection closed
+};
+
+struct Stats {
+    std::vector<int64_t> latencyUs;
+    std::vector<uint64_t> perRange;
+    uint64_t bytesSent = 0;
+    uint64_t bytesReceived = 0;
+    uint64_t records = 0;
+    uint64_t notModified = 0;
+    uint64_t connectFailures = 0;
+    uint64_t unexpectedCloses = 0;  // host closed the connection before the run ended
+    uint64_t sendErrors = 0;
+    uint64_t badResponses = 0;
+};
+
+void usage(const char* prog) {
+    std::cerr
+        << "Usage: " << prog << " [options]\n"
+        << "  --url URL             WebSocket endpoint (default ws://127.0.0.1:8080/ws?token=token123)\n"
+        << "  --plugin NAME         plugin name in pluginArg (default Exchange_rate)\n"
+        << "  --connections N       concurrent connections (default 16)\n"
+        << "  --duration SEC        test duration in seconds (default 30)\n"
+        << "  --mix LIST            comma separated startDate:endDate[:weight] ranges\n"
+        << "                        (default 20251101:20251125:4,20250101:20251128:1)\n"
+        << "  --seed N              random seed for the range mix (default 1)\n"
+        << "  --conditional         send ifVersion/ifHash from the previous response per range\n"
+        << "  --gen-fixture PATH    write a synthetic hk_exchange_rate JSON file and exit\n"
+        << "  --from YYYYMMDD       first trade date of the fixture (default 20240101)\n"
+        << "  --to YYYYMMDD         last trade date of the fixture (default 20251231)\n";
+}
+
+bool isDigits(const std::string& text) {
+    return !text.empty() && std::all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; });
+}
+
+bool isDateKey(const std::string& text) {
+    return text.size() == 8 && isDigits(text);
+}
+
+std::vector<RangeSpec> parseMix(const std::string& text) {
+    std::vector<RangeSpec> mix;
+    std::stringstream list(text);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        if (item.empty()) continue;
+        std::vector<std::string> fields;
+        std::stringstream parts(item);
+        std::string field;
+        while (std::getline(parts, field, ':')) {
+            fields.push_back(field);
+        }
+        if (fields.size() < 2 || fields.size() > 3 ||
+            !isDateKey(fields[0]) || !isDateKey(fields[1])) {
+            throw std::invalid_argument("bad --mix entry: " + item);
+        }
+        RangeSpec range;
+        range.startDate = fields[0];
+        range.endDate = fields[1];
+        if (fields.size() == 3) {
+            const std::string& weight = fields[2];
+            if (!isDigits(weight) || weight.size() > 9 || std::stoul(weight) == 0) {
+                throw std::invalid_argument("bad --mix weight (must be a positive integer): " + item);
+            }
+            range.weight = static_cast<unsigned>(std::stoul(weight));
+        }
+        mix.push_back(range);
+    }
+    if (mix.empty()) {
+        throw std::invalid_argument("--mix is empty");
+    }
+    return mix;
+}
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+            return argv[++i];
+        };
+        if (arg == "--url") opt.url = next();
+        else if (arg == "--plugin") opt.pluginName = next();
+        else if (arg == "--connections") opt.connections = std::stoi(next());
+        else if (arg == "--duration") opt.durationSec = std::stoi(next());
+        else if (arg == "--mix") opt.mix = parseMix(next());
+        else if (arg == "--seed") opt.seed = static_cast<unsigned>(std::stoul(next()));
+        else if (arg == "--conditional") opt.conditional = true;
+        else if (arg == "--gen-fixture") opt.fixturePath = next();
+        else if (arg == "--from") opt.fixtureFrom = next();
+        else if (arg == "--to") opt.fixtureTo = next();
+        else if (arg == "-h" || arg == "--help") return false;
+        else throw std::invalid_argument("unknown option " + arg);
+    }
+    if (opt.mix.empty()) {
+        opt.mix = parseMix("20251101:20251125:4,20250101:20251128:1");
+    }
+    if (!isDateKey(opt.fixtureFrom) || !isDateKey(opt.fixtureTo)) {
+        throw std::invalid_argument("--from and --to must be YYYYMMDD dates");
+    }
+    if (opt.connections <= 0 || opt.durationSec <= 0) {
+        throw std::invalid_argument("--connections and --duration must be positive");
+    }
+    return true;
+}
+
+std::tm parseDate(const std::string& yyyymmdd) {
+    std::tm tm = {};
+    std::istringstream in(yyyymmdd);
+    in >> std::get_time(&tm, "%Y%m%d");
+    if (in.fail()) {
+        throw std::invalid_argument("bad date " + yyyymmdd);
+    }
+    tm.tm_hour = 12;
+    return tm;
+}
+
+// Writes weekday records with the hk_exchange_rate columns the frontend reads.
+void writeFixture(const Options& opt) {
+    std::tm day = parseDate(opt.fixtureFrom);
+    std::tm last = parseDate(opt.fixtureTo);
+    std::time_t lastTime = std::mktime(&last);
+
+    std::mt19937 rng(opt.seed);
+    std::normal_distribution<double> step(0.0, 0.0015);
+    double mid = 0.9100;
+
+    nlohmann::json data = nlohmann::json::array();
+    for (std::time_t t = std::mktime(&day); t <= lastTime; ) {
+        if (day.tm_wday != 0 && day.tm_wday != 6) {
+            mid = std::max(0.80, std::min(1.00, mid + step(rng)));
+            char key[9];
+            std::strftime(key, sizeof(key), "%Y%m%d", &day);
+            nlohmann::json rec;
+            rec["tradeDateKey"] = std::atoi(key);
+            rec["midRefExchangeRate"] = mid;
+            rec["valExchangeRate"] = mid + 0.0002;
+            rec["buySetExchangeRate"] = mid - 0.0270;
+            rec["sellSetExchangeRate"] = mid + 0.0270;
+            data.push_back(rec);
+        }
+        day.tm_mday += 1;
+        t = std::mktime(&day);
+    }
+
+    std::ofstream out(opt.fixturePath);
+    if (!out) {
+        throw std::runtime_error("cannot write " + opt.fixturePath);
+    }
+    out << data.dump();
+    std::cout << "Wrote " << data.size() << " records to " << opt.fixturePath << std::endl;
+}
+
+int64_t percentile(const std::vector<int64_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t rank = static_cast<size_t>(p * sorted.size());
+    if (rank >= sorted.size()) rank = sorted.size() - 1;
+    return sorted[rank];
+}
+
+class LoadGenerator {
+public:
+    explicit LoadGenerator(const Options& opt)
+        : m_opt(opt) {
+        std::vector<double> weights;
+        for (const auto& range : opt.mix) weights.push_back(range.weight);
+        m_pick = std::discrete_distribution<size_t>(weights.begin(), weights.end());
+        m_stats.perRange.assign(opt.mix.size(), 0);
+        m_client.clear_access_channels(websocketpp::log::alevel::all);
+        m_client.clear_error_channels(websocketpp::log::elevel::all);
+        m_client.init_asio();
+    }
+
+    void run() {
+        m_conns.resize(m_opt.connections);
+        for (int i = 0; i < m_opt.connections; ++i) {
+            ConnState& conn = m_conns[i];
+            conn.instanceId = "loadgen-" + std::to_string(i);
+            conn.rng.seed(m_opt.seed + i);
+            conn.lastSeen.assign(m_opt.mix.size(), std::make_pair(uint64_t(0), std::string()));
+
+            websocketpp::lib::error_code ec;
+            WsClient::connection_ptr con = m_client.get_connection(m_opt.url, ec);
+            if (ec) {
+                throw std::runtime_error("invalid url " + m_opt.url + ": " + ec.message());
+            }
+            con->set_open_handler([this, i](websocketpp::connection_hdl hdl) { onOpen(i, hdl); });
+            con->set_message_handler([this, i](websocketpp::connection_hdl, WsClient::message_ptr msg) {
+                onMessage(i, msg->get_payload());
+            });
+            con->set_fail_handler([this, i](websocketpp::connection_hdl) {
+                ++m_stats.connectFailures;
+                onFinished(i);
+            });
+            con->set_close_handler([this, i](websocketpp::connection_hdl) {
+                if (m_conns[i].open && !m_stopping) {
+                    ++m_stats.unexpectedCloses;
+                }
+                onFinished(i);
+            });
+            m_client.connect(con);
+        }
+
+        m_started = Clock::now();
+        m_deadline = m_started + std::chrono::seconds(m_opt.durationSec);
+        m_client.set_timer(m_opt.durationSec * 1000L, [this](const websocketpp::lib::error_code&) { onDeadline(); });
+        m_client.run();
+    }
+
+    // False when nothing completed or no connection survived the run, so scripted
+    // regression checks can fail on the exit code.
+    bool succeeded() const {
+        uint64_t lost = m_stats.connectFailures + m_stats.unexpectedCloses;
+        return !m_stats.latencyUs.empty() && lost < static_cast<uint64_t>(m_opt.connections);
+    }
+
+    void report() const {
+        std::vector<int64_t> sorted = m_stats.latencyUs;
+        std::sort(sorted.begin(), sorted.end());
+        double elapsed = std::chrono::duration<double>(m_finished - m_started).count();
+        if (elapsed <= 0) elapsed = m_opt.durationSec;
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << "connections:     " << m_opt.connections
+                  << " (" << m_stats.connectFailures << " failed, "
+                  << m_stats.unexpectedCloses << " closed by host)\n"
+                  << "elapsed:         " << elapsed << " s\n"
+                  << "requests:        " << sorted.size() << "\n"
+                  << "throughput:      " << sorted.size() / elapsed << " req/s\n"
+                  << "latency p50:     " << percentile(sorted, 0.50) / 1000.0 << " ms\n"
+                  << "latency p99:     " << percentile(sorted, 0.99) / 1000.0 << " ms\n"
+                  << "latency p999:    " << percentile(sorted, 0.999) / 1000.0 << " ms\n"
+                  << "latency max:     " << (sorted.empty() ? 0 : sorted.back()) / 1000.0 << " ms\n"
+                  << "received:        " << m_stats.bytesReceived / elapsed / (1024.0 * 1024.0) << " MiB/s ("
+                  << m_stats.records << " records)\n"
+                  << "not modified:    " << m_stats.notModified << "\n"
+                  << "sent:            " << m_stats.bytesSent / elapsed / 1024.0 << " KiB/s\n"
+                  << "send errors:     " << m_stats.sendErrors << "\n"
+                  << "bad responses:   " << m_stats.badResponses << "\n";
+        for (size_t r = 0; r < m_opt.mix.size(); ++r) {
+            std::cout << "  range " << m_opt.mix[r].startDate << "-" << m_opt.mix[r].endDate
+                      << ": " << m_stats.perRange[r] << " requests\n";
+        }
+    }
+
+private:
+    const Options& m_opt;
+    WsClient m_client;
+    std::vector<ConnState> m_conns;
+    std::discrete_distribution<size_t> m_pick;
+    Stats m_stats;
+    Clock::time_point m_started;
+    Clock::time_point m_deadline;
+    Clock::time_point m_finished;
+    bool m_stopping = false;
+
+    void onOpen(int i, websocketpp::connection_hdl hdl) {
+        m_conns[i].hdl = hdl;
+        m_conns[i].open = true;
+        sendNext(i);
+    }
+
+    void sendNext(int i) {
+        ConnState& conn = m_conns[i];
+        if (m_stopping) {
+            closeConn(i);
+            return;
+        }
+        conn.rangeIdx = m_pick(conn.rng);
+        const RangeSpec& range = m_opt.mix[conn.rangeIdx];
+
+        nlohmann::json request;
+        request["pluginArg"]["name"] = m_opt.pluginName;
+        request["pluginArg"]["instanceId"] = conn.instanceId;
+        request["startDate"] = range.startDate;
+        request["endDate"] = range.endDate;
+        const auto& seen = conn.lastSeen[conn.rangeIdx];
+        if (m_opt.conditional && !seen.second.empty()) {
+            request["ifVersion"] = seen.first;
+            request["ifHash"] = seen.second;
+        }
+        std::string payload = request.dump();
+
+        websocketpp::lib::error_code ec;
+        conn.sentAt = Clock::now();
+        conn.inFlight = true;
+        m_client.send(conn.hdl, payload, websocketpp::frame::opcode::text, ec);
+        if (ec) {
+            ++m_stats.sendErrors;
+            conn.inFlight = false;
+            closeConn(i);
+            return;
+        }
+        m_stats.bytesSent += payload.size();
+    }
+
+    void onMessage(int i, const std::string& payload) {
+        ConnState& conn = m_conns[i];
+        if (!conn.inFlight) return;
+
+        // Only responses routed back to this connection's instance complete a request;
+        // anything else the host pushes (e.g. pings) is ignored.
+        nlohmann::json response = nlohmann::json::parse(payload, nullptr, false);
+        if (response.is_discarded() || !response.contains("pluginArg")) {
+            ++m_stats.badResponses;
+            return;
+        }
+        const auto& pluginArg = response["pluginArg"];
+        if (!pluginArg.is_object() || pluginArg.value("instanceId", "") != conn.instanceId) {
+            return;
+        }
+
+        auto now = Clock::now();
+        conn.inFlight = false;
+        m_stats.latencyUs.push_back(
+            std::chrono::duration_cast<std::chrono::microseconds>(now - conn.sentAt).count());
+        m_stats.perRange[conn.rangeIdx] += 1;
+        m_stats.bytesReceived += payload.size();
+        if (response.value("notModified", false)) {
+            ++m_stats.notModified;
+        }
+        else if (response.contains("data") && response["data"].is_array()) {
+            m_stats.records += response["data"].size();
+        }
+        else {
+            ++m_stats.badResponses;
+        }
+        // A version-only notModified reply carries no dataHash; keep the one the server sent earlier
+        auto& seen = conn.lastSeen[conn.rangeIdx];
+        if (response.contains("dataVersion") && response["dataVersion"].is_number_unsigned()) {
+            seen.first = response["dataVersion"].get<uint64_t>();
+        }
+        if (response.contains("dataHash") && response["dataHash"].is_string()) {
+            seen.second = response["dataHash"].get<std::string>();
+        }
+        m_finished = now;
+
+        if (now >= m_deadline) {
+            m_stopping = true;
+        }
+        sendNext(i);
+    }
+
+    void onDeadline() {
+        m_stopping = true;
+        if (m_finished < m_started) m_finished = Clock::now();
+        for (size_t i = 0; i < m_conns.size(); ++i) {
+            if (!m_conns[i].inFlight) closeConn(static_cast<int>(i));
+        }
+        // Give in-flight requests a short grace period, then stop regardless.
+        m_client.set_timer(5000, [this](const websocketpp::lib::error_code&) { m_client.stop(); });
+    }
+
+    void closeConn(int i) {
+        ConnState& conn = m_conns[i];
+        if (!conn.open) return;
+        conn.open = false;
+        websocketpp::lib::error_code ec;
+        m_client.close(conn.hdl, websocketpp::close::status::normal, "load test finished", ec);
+    }
+
+    // Stop as soon as every connection has failed or closed, instead of waiting out --duration.
+    void onFinished(int i) {
+        ConnState& conn = m_conns[i];
+        conn.open = false;
+        conn.inFlight = false;
+        conn.finished = true;
+        if (std::all_of(m_conns.begin(), m_conns.end(), [](const ConnState& c) { return c.finished; })) {
+            if (m_finished < m_started) m_finished = Clock::now();
+            m_client.stop();
+        }
+    }
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    try {
+        if (!parseArgs(argc, argv, opt)) {
+            usage(argv[0]);
+            return 0;
+        }
+        if (!opt.fixturePath.empty()) {
+            writeFixture(opt);
+            return 0;
+        }
+
+        std::cout << "Running " << opt.connections << " connections against " << opt.url
+                  << " for " << opt.durationSec << " s" << std::endl;
+        LoadGenerator generator(opt);
+        generator.run();
+        generator.report();
+        if (!generator.succeeded()) {
+            std::cerr << "exchange_rate_loadgen: no requests completed or all connections were lost" << std::endl;
+            return 2;
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "exchange_rate_loadgen: " << e.what() << std::endl;
+        usage(argv[0]);
+        return 1;
+    }
+    return 0;
+}